@@ -11,7 +11,14 @@ struct APIConfig {
     std::string baseUrl = "https://your-replit-app.replit.app";
     std::string apiKey = "";  // X-API-Key for server authentication
     std::string openAiKey = ""; // Optional: personal OpenAI key for AI calls
-    int timeoutMs = 30000;
+    int timeoutMs = 30000;      // StrangerDrumsClient: connect timeout and longest silence from the server
+
+    // Used by StrangerDrumsClient
+    int maxInFlight = 4;          // concurrent requests, the rest queue
+    int maxRetries = 3;           // retries on 429, 5xx and requests that never left the client
+    int retryBaseDelayMs = 250;
+    int retryMaxDelayMs = 8000;
+    int readChunkSize = 8192;     // largest piece passed to a chunk callback
 };
 
 struct GenerateRequest {
@@ -0,0 +1,758 @@
+#pragma once
+
+#include "StrangerDrumsAPI.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace StrangerDrums {
+
+// Per-stage timing of the final attempt, in milliseconds.
+// connectMs covers DNS, TCP and TLS setup and is 0 when a kept-alive
+// connection was reused. ttfbMs runs from the connection being ready to the
+// first response byte (sending the request plus server time). bodyMs is the
+// time spent draining the response. If no response arrived, ttfbMs and
+// bodyMs stay 0.
+struct HttpTiming {
+    double connectMs = 0.0;
+    double ttfbMs = 0.0;
+    double bodyMs = 0.0;
+    double totalMs = 0.0;
+};
+
+struct HttpResponse {
+    bool success = false;
+    int statusCode = 0;             // 0 when no response was received
+    int attempts = 0;
+    bool requestSent = false;       // request body left the client
+    bool reusedConnection = false;  // served over a kept-alive connection
+    std::string body;
+    std::string error;
+    HttpTiming timing;
+};
+
+namespace detail {
+
+// Just enough JSON to read the API responses
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<std::string> keys;      // Object
+    std::vector<JsonValue> values;      // Array items or Object values
+
+    const JsonValue* get(const std::string& key) const {
+        if (type != Type::Object) return nullptr;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == key) return &values[i];
+        }
+        return nullptr;
+    }
+
+    int getInt(const std::string& key, int fallback = 0) const {
+        auto* value = get(key);
+        return value != nullptr && value->type == Type::Number
+            ? static_cast<int>(value->number) : fallback;
+    }
+
+    std::string getString(const std::string& key) const {
+        auto* value = get(key);
+        return value != nullptr && value->type == Type::String ? value->string : "";
+    }
+};
+
+class JsonParser {
+public:
+    static bool parse(const std::string& text, JsonValue& out) {
+        JsonParser parser(text);
+        if (!parser.parseValue(out, 0)) return false;
+        parser.skipWhitespace();
+        return parser.pos == text.size();
+    }
+
+private:
+    explicit JsonParser(const std::string& source) : text(source) {}
+
+    const std::string& text;
+    size_t pos = 0;
+
+    static constexpr int maxDepth = 64;
+
+    void skipWhitespace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t'
+               || text[pos] == '\n' || text[pos] == '\r')) {
+            ++pos;
+        }
+    }
+
+    bool consume(const char* literal) {
+        size_t length = std::char_traits<char>::length(literal);
+        if (text.compare(pos, length, literal) != 0) return false;
+        pos += length;
+        return true;
+    }
+
+    bool parseValue(JsonValue& out, int depth) {
+        if (depth > maxDepth) return false;
+        skipWhitespace();
+        if (pos >= text.size()) return false;
+
+        char c = text[pos];
+        if (c == '{') return parseObject(out, depth);
+        if (c == '[') return parseArray(out, depth);
+        if (c == '"') {
+            out.type = JsonValue::Type::String;
+            return parseString(out.string);
+        }
+        if (consume("true")) { out.type = JsonValue::Type::Bool; out.boolean = true; return true; }
+        if (consume("false")) { out.type = JsonValue::Type::Bool; out.boolean = false; return true; }
+        if (consume("null")) { out.type = JsonValue::Type::Null; return true; }
+        return parseNumber(out);
+    }
+
+    bool parseObject(JsonValue& out, int depth) {
+        out.type = JsonValue::Type::Object;
+        ++pos;
+        skipWhitespace();
+        if (pos < text.size() && text[pos] == '}') { ++pos; return true; }
+
+        while (true) {
+            skipWhitespace();
+            std::string key;
+            if (pos >= text.size() || text[pos] != '"' || !parseString(key)) return false;
+
+            skipWhitespace();
+            if (pos >= text.size() || text[pos] != ':') return false;
+            ++pos;
+
+            JsonValue value;
+            if (!parseValue(value, depth + 1)) return false;
+            out.keys.push_back(std::move(key));
+            out.values.push_back(std::move(value));
+
+            skipWhitespace();
+            if (pos >= text.size()) return false;
+            if (text[pos] == ',') { ++pos; continue; }
+            if (text[pos] == '}') { ++pos; return true; }
+            return false;
+        }
+    }
+
+    bool parseArray(JsonValue& out, int depth) {
+        out.type = JsonValue::Type::Array;
+        ++pos;
+        skipWhitespace();
+        if (pos < text.size() && text[pos] == ']') { ++pos; return true; }
+
+        while (true) {
+            JsonValue value;
+            if (!parseValue(value, depth + 1)) return false;
+            out.values.push_back(std::move(value));
+
+            skipWhitespace();
+            if (pos >= text.size()) return false;
+            if (text[pos] == ',') { ++pos; continue; }
+            if (text[pos] == ']') { ++pos; return true; }
+            return false;
+        }
+    }
+
+    bool parseString(std::string& out) {
+        ++pos;
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') return true;
+            if (c != '\\') { out += c; continue; }
+            if (pos >= text.size()) return false;
+
+            char escape = text[pos++];
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned int codePoint = 0;
+                    if (!parseHex4(codePoint)) return false;
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00 && consume("\\u")) {
+                        unsigned int low = 0;
+                        if (!parseHex4(low)) return false;
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codePoint);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    bool parseHex4(unsigned int& out) {
+        if (pos + 4 > text.size()) return false;
+        for (int i = 0; i < 4; ++i) {
+            char c = text[pos++];
+            out <<= 4;
+            if (c >= '0' && c <= '9') out |= static_cast<unsigned int>(c - '0');
+            else if (c >= 'a' && c <= 'f') out |= static_cast<unsigned int>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') out |= static_cast<unsigned int>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned int codePoint) {
+        if (codePoint < 0x80) {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    bool parseNumber(JsonValue& out) {
+        size_t start = pos;
+        while (pos < text.size() && std::string("+-0123456789.eE").find(text[pos]) != std::string::npos) {
+            ++pos;
+        }
+        if (pos == start) return false;
+
+        std::string number = text.substr(start, pos - start);
+        char* end = nullptr;
+        out.number = std::strtod(number.c_str(), &end);
+        out.type = JsonValue::Type::Number;
+        return end == number.c_str() + number.size();
+    }
+};
+
+} // namespace detail
+
+// Async client for the Stranger Drums API, built on libcurl.
+//
+// Requests run on APIConfig::maxInFlight worker threads, so at most that many
+// are in flight and the rest queue. The workers share one curl connection
+// cache (plus DNS and TLS sessions), so a request reuses any idle kept-alive
+// connection to the same host instead of reconnecting.
+//
+// 429, 5xx and failures where the request never left the client are retried
+// with exponential backoff and full jitter. A Retry-After header (in seconds)
+// on 429 or 503 replaces the backoff delay. Both endpoints are non-idempotent
+// and each call costs an AI request, so once the request body has been sent
+// the request is only retried on 429/5xx: a timeout or reset after sending,
+// or any failure after a 2xx status, is reported as is. A body cut short of
+// its Content-Length or final chunk is reported with success = false and the
+// 2xx statusCode; a close-delimited body can't be told apart from a complete one.
+//
+// Callbacks are passed to the dispatcher given to the constructor (e.g. one
+// that posts to the JUCE message thread), or called on the worker thread if
+// there is none. Chunk callbacks are always called on the worker thread as a
+// 2xx body streams in, at most APIConfig::readChunkSize bytes at a time; since
+// 2xx responses are never retried, each byte is delivered at most once.
+//
+// Keep the client alive for as long as its requests should run: destroying it
+// cancels everything still pending.
+class StrangerDrumsClient {
+public:
+    using ResponseCallback = std::function<void(const HttpResponse&)>;
+    using ChunkCallback = std::function<void(const char* data, size_t size)>;
+    using Dispatcher = std::function<void(std::function<void()>)>;
+
+    StrangerDrumsClient(const APIConfig& config, Dispatcher dispatcher = nullptr)
+        : m_config(config), m_api(config), m_dispatcher(std::move(dispatcher)),
+          m_alive(std::make_shared<std::atomic<bool>>(true)) {
+        static std::once_flag curlInit;
+        std::call_once(curlInit, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+        m_share = curl_share_init();
+        curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, &StrangerDrumsClient::lockShare);
+        curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, &StrangerDrumsClient::unlockShare);
+        curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+        for (int i = 0; i < std::max(1, config.maxInFlight); ++i) {
+            auto worker = std::make_unique<Worker>();
+            worker->multi = curl_multi_init();
+            worker->rng.seed(std::random_device{}());
+            m_workers.push_back(std::move(worker));
+        }
+        for (auto& worker : m_workers) {
+            Worker* w = worker.get();
+            w->thread = std::thread([this, w] { workerLoop(*w); });
+        }
+    }
+
+    // Must not be called from one of this client's callbacks
+    ~StrangerDrumsClient() {
+        cancelAll();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            for (auto& worker : m_workers) curl_multi_wakeup(worker->multi);
+        }
+        m_wake.notify_all();
+        m_retry.notify_all();
+
+        for (auto& worker : m_workers) {
+            worker->thread.join();
+            curl_multi_cleanup(worker->multi);
+        }
+        curl_share_cleanup(m_share);
+    }
+
+    void generatePattern(const GenerateRequest& req,
+                         std::function<void(const GenerateResponse&)> onDone) {
+        post(m_api.buildGenerateUrl(), m_api.buildGenerateRequestBody(req),
+            [onDone](const HttpResponse& response) {
+                if (onDone) onDone(parseGenerateResponse(response));
+            });
+    }
+
+    void generateSmartBeat(const SmartBeatRequest& req,
+                           std::function<void(const GenerateResponse&)> onDone) {
+        post(m_api.buildSmartBeatUrl(), m_api.buildSmartBeatRequestBody(req),
+            [onDone](const HttpResponse& response) {
+                if (onDone) onDone(parseGenerateResponse(response));
+            });
+    }
+
+    // Queue a POST to an absolute URL. onChunk (optional) receives the body
+    // of a successful response as it is read.
+    void post(const std::string& url, const std::string& body,
+              ResponseCallback onDone, ChunkCallback onChunk = nullptr) {
+        auto request = std::make_shared<Request>();
+        request->url = url;
+        request->body = body;
+        request->onDone = std::move(onDone);
+        request->onChunk = std::move(onChunk);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            request->alive = m_alive;
+            m_queue.push_back(std::move(request));
+        }
+        m_wake.notify_one();
+    }
+
+    // Requests queued or running
+    int getNumPending() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<int>(m_queue.size() + m_active.size());
+    }
+
+    // Abort running requests and drop queued ones, then wait up to
+    // cancelTimeoutMs for the workers to stop. Callbacks of these requests,
+    // and dispatched ones that haven't run yet, are not called.
+    // Returns false if a worker is still busy when the wait ends, e.g. stuck in
+    // a slow chunk callback; getNumPending() is then still above 0.
+    // Must not be called from one of this client's callbacks on a worker
+    // thread: it can't wait for itself, so it asserts and returns false.
+    bool cancelAll() {
+        bool onWorkerThread = currentClient() == this;
+        assert(!onWorkerThread && "cancelAll() called from a worker thread");
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_alive->store(false);
+        m_alive = std::make_shared<std::atomic<bool>>(true);
+        m_queue.clear();
+        for (auto& request : m_active) request->cancelled = true;
+        for (auto& worker : m_workers) curl_multi_wakeup(worker->multi);
+        m_retry.notify_all();
+
+        if (onWorkerThread) return false;
+        return m_idle.wait_for(lock, std::chrono::milliseconds(cancelTimeoutMs),
+                               [this] { return m_active.empty(); });
+    }
+
+    static GenerateResponse parseGenerateResponse(const HttpResponse& response) {
+        GenerateResponse result;
+        detail::JsonValue json;
+        bool parsed = detail::JsonParser::parse(response.body, json);
+
+        if (!response.success) {
+            auto message = parsed ? json.getString("message") : std::string();
+            result.error = !message.empty() ? message : response.error;
+            return result;
+        }
+
+        auto* grid = parsed ? json.get("grid") : nullptr;
+        if (grid == nullptr || grid->type != detail::JsonValue::Type::Array) {
+            result.error = "Invalid grid data in response";
+            return result;
+        }
+
+        for (const auto& item : grid->values) {
+            GridStep gs;
+            gs.step = item.getInt("step");
+            gs.drum = StrangerDrumsAPI::parseDrumString(item.getString("drum"));
+            gs.velocity = item.getInt("velocity");
+            result.grid.push_back(gs);
+        }
+
+        result.suggestedName = json.getString("suggestedName");
+        result.success = true;
+        return result;
+    }
+
+    // Whether an HTTP error status may be retried
+    static bool isRetryableStatus(int statusCode) {
+        return statusCode == 429 || statusCode >= 500;
+    }
+
+    // Whether a failed attempt may be retried without risking a duplicate call
+    static bool isRetryable(const HttpResponse& response) {
+        if (response.success) return false;
+        if (response.statusCode == 0) return !response.requestSent;
+        return isRetryableStatus(response.statusCode);
+    }
+
+    // Full jitter: uniform in [0, min(retryMaxDelayMs, retryBaseDelayMs * 2^(attempt - 1))]
+    static int backoffDelayMs(const APIConfig& config, int attempt, std::mt19937& rng) {
+        double cap = std::min<double>(config.retryMaxDelayMs,
+            config.retryBaseDelayMs * std::pow(2.0, attempt - 1));
+        std::uniform_int_distribution<> dist(0, std::max(0, static_cast<int>(cap)));
+        return dist(rng);
+    }
+
+    // Delay from a Retry-After header given in seconds, capped at
+    // retryMaxDelayMs. Returns -1 if the header is missing or not in seconds.
+    static int retryAfterDelayMs(const std::string& retryAfter, const APIConfig& config) {
+        auto first = retryAfter.find_first_not_of(" \t");
+        auto last = retryAfter.find_last_not_of(" \t\r\n");
+        if (first == std::string::npos) return -1;
+
+        auto value = retryAfter.substr(first, last - first + 1);
+        if (value.find_first_not_of("0123456789") != std::string::npos) return -1;
+
+        // More digits than fit in the cap anyway
+        if (value.size() > 9) return config.retryMaxDelayMs;
+        long long delayMs = std::stoll(value) * 1000;
+        return static_cast<int>(std::min<long long>(delayMs, config.retryMaxDelayMs));
+    }
+
+    // How long cancelAll() waits for workers after aborting their transfers
+    static constexpr int cancelTimeoutMs = 1000;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        std::string url;
+        std::string body;
+        ResponseCallback onDone;
+        ChunkCallback onChunk;
+        std::shared_ptr<std::atomic<bool>> alive;
+        std::atomic<bool> cancelled { false };
+    };
+
+    struct Worker {
+        std::thread thread;
+        CURLM* multi = nullptr;
+        std::mt19937 rng;
+    };
+
+    // State shared with the curl callbacks of one attempt
+    struct Transfer {
+        CURL* easy = nullptr;
+        Request* request = nullptr;
+        HttpResponse* response = nullptr;
+        size_t chunkSize = 1;
+        std::string retryAfter;
+        Clock::time_point firstByteAt {};
+        Clock::time_point lastActivity {};
+        bool gotFirstByte = false;
+    };
+
+    static const StrangerDrumsClient*& currentClient() {
+        thread_local const StrangerDrumsClient* client = nullptr;
+        return client;
+    }
+
+    static double millisecondsBetween(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    void workerLoop(Worker& worker) {
+        currentClient() = this;
+
+        while (true) {
+            std::shared_ptr<Request> request;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if (m_stopping) return;
+
+                request = m_queue.front();
+                m_queue.pop_front();
+                m_active.push_back(request);
+            }
+
+            auto response = runRequest(worker, *request);
+            if (!request->cancelled) deliver(*request, response);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_active.erase(std::find(m_active.begin(), m_active.end(), request));
+            }
+            m_idle.notify_all();
+        }
+    }
+
+    HttpResponse runRequest(Worker& worker, Request& request) {
+        for (int attempt = 1; ; ++attempt) {
+            int retryAfterMs = -1;
+            auto response = performAttempt(worker.multi, request, retryAfterMs);
+            response.attempts = attempt;
+
+            if (request.cancelled || !isRetryable(response) || attempt > m_config.maxRetries) {
+                return response;
+            }
+
+            int delayMs = retryAfterMs >= 0 ? retryAfterMs
+                                            : backoffDelayMs(m_config, attempt, worker.rng);
+            if (!waitForRetry(request, delayMs)) return response;
+        }
+    }
+
+    // Returns false if the request was cancelled while waiting
+    bool waitForRetry(Request& request, int delayMs) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return !m_retry.wait_for(lock, std::chrono::milliseconds(delayMs),
+            [this, &request] { return request.cancelled.load() || m_stopping; });
+    }
+
+    HttpResponse performAttempt(CURLM* multi, Request& request, int& retryAfterMs) {
+        HttpResponse response;
+        CURL* easy = curl_easy_init();
+        if (easy == nullptr) {
+            response.error = "Failed to create a curl handle";
+            return response;
+        }
+
+        Transfer transfer;
+        transfer.easy = easy;
+        transfer.request = &request;
+        transfer.response = &response;
+        transfer.chunkSize = static_cast<size_t>(std::max(1, m_config.readChunkSize));
+
+        curl_slist* headers = nullptr;
+        auto headerText = m_api.getRequestHeaders();
+        for (size_t start = 0, end; (end = headerText.find("\r\n", start)) != std::string::npos; start = end + 2) {
+            headers = curl_slist_append(headers, headerText.substr(start, end - start).c_str());
+        }
+        headers = curl_slist_append(headers, "Expect:");
+
+        curl_easy_setopt(easy, CURLOPT_SHARE, m_share);
+        curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+        curl_easy_setopt(easy, CURLOPT_POST, 1L);
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request.body.data());
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body.size()));
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(m_config.timeoutMs));
+        curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, &StrangerDrumsClient::onHeader);
+        curl_easy_setopt(easy, CURLOPT_HEADERDATA, &transfer);
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &StrangerDrumsClient::onWrite);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer);
+
+        auto start = Clock::now();
+        transfer.lastActivity = start;
+        bool cancelled = false;
+        bool timedOut = false;
+        CURLcode result = CURLE_OK;
+
+        curl_multi_add_handle(multi, easy);
+        while (true) {
+            int running = 0;
+            if (curl_multi_perform(multi, &running) != CURLM_OK) {
+                result = CURLE_FAILED_INIT;
+                break;
+            }
+            if (running == 0) {
+                int remaining = 0;
+                while (CURLMsg* message = curl_multi_info_read(multi, &remaining)) {
+                    if (message->msg == CURLMSG_DONE && message->easy_handle == easy) {
+                        result = message->data.result;
+                    }
+                }
+                break;
+            }
+            if (request.cancelled) {
+                cancelled = true;
+                break;
+            }
+            // timeoutMs also bounds how long the server may go quiet
+            if (millisecondsBetween(transfer.lastActivity, Clock::now()) > m_config.timeoutMs) {
+                timedOut = true;
+                break;
+            }
+            curl_multi_poll(multi, nullptr, 0, 50, nullptr);
+        }
+        auto end = Clock::now();
+
+        long statusCode = 0;
+        long newConnections = 0;
+        curl_off_t uploaded = 0;
+        curl_off_t connectUs = 0;
+        curl_off_t appConnectUs = 0;
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &statusCode);
+        curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &newConnections);
+        curl_easy_getinfo(easy, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+        curl_easy_getinfo(easy, CURLINFO_CONNECT_TIME_T, &connectUs);
+        curl_easy_getinfo(easy, CURLINFO_APPCONNECT_TIME_T, &appConnectUs);
+
+        curl_multi_remove_handle(multi, easy);
+        curl_easy_cleanup(easy);
+        curl_slist_free_all(headers);
+
+        response.statusCode = static_cast<int>(statusCode);
+        response.requestSent = uploaded > 0 || (request.body.empty() && statusCode > 0);
+        response.reusedConnection = newConnections == 0 && (statusCode > 0 || uploaded > 0);
+        response.timing.totalMs = millisecondsBetween(start, end);
+        if (!response.reusedConnection) {
+            response.timing.connectMs = static_cast<double>(std::max(connectUs, appConnectUs)) / 1000.0;
+        }
+        if (transfer.gotFirstByte) {
+            response.timing.ttfbMs = std::max(0.0,
+                millisecondsBetween(start, transfer.firstByteAt) - response.timing.connectMs);
+            response.timing.bodyMs = millisecondsBetween(transfer.firstByteAt, end);
+        }
+
+        if (cancelled) {
+            response.error = "Cancelled";
+            return response;
+        }
+        if (timedOut) {
+            response.error = "No data for " + std::to_string(m_config.timeoutMs) + " ms";
+            return response;
+        }
+        if (result == CURLE_PARTIAL_FILE || (result != CURLE_OK && statusCode >= 200 && statusCode < 300)) {
+            response.error = std::string("Response truncated: ") + curl_easy_strerror(result);
+            return response;
+        }
+        if (result != CURLE_OK) {
+            response.error = std::string("Request to ") + request.url + " failed: "
+                + curl_easy_strerror(result);
+            return response;
+        }
+        if (statusCode < 200 || statusCode >= 300) {
+            response.error = "HTTP " + std::to_string(statusCode);
+            if (statusCode == 429 || statusCode == 503) {
+                retryAfterMs = retryAfterDelayMs(transfer.retryAfter, m_config);
+            }
+            return response;
+        }
+
+        response.success = true;
+        return response;
+    }
+
+    static size_t onHeader(char* data, size_t size, size_t count, void* userData) {
+        auto& transfer = *static_cast<Transfer*>(userData);
+        std::string line(data, size * count);
+        transfer.lastActivity = Clock::now();
+
+        if (line.compare(0, 5, "HTTP/") == 0) {
+            transfer.retryAfter.clear();
+            if (!transfer.gotFirstByte) {
+                transfer.gotFirstByte = true;
+                transfer.firstByteAt = transfer.lastActivity;
+            }
+        } else if (line.size() > 12) {
+            std::string name = line.substr(0, 12);
+            std::transform(name.begin(), name.end(), name.begin(),
+                [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+            if (name == "retry-after:") transfer.retryAfter = line.substr(12);
+        }
+        return size * count;
+    }
+
+    static size_t onWrite(char* data, size_t size, size_t count, void* userData) {
+        auto& transfer = *static_cast<Transfer*>(userData);
+        size_t length = size * count;
+        transfer.lastActivity = Clock::now();
+        transfer.response->body.append(data, length);
+
+        if (transfer.request->onChunk) {
+            long statusCode = 0;
+            curl_easy_getinfo(transfer.easy, CURLINFO_RESPONSE_CODE, &statusCode);
+            if (statusCode >= 200 && statusCode < 300) {
+                for (size_t offset = 0; offset < length; offset += transfer.chunkSize) {
+                    transfer.request->onChunk(data + offset, std::min(transfer.chunkSize, length - offset));
+                }
+            }
+        }
+        return length;
+    }
+
+    static void lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userData) {
+        static_cast<StrangerDrumsClient*>(userData)->m_shareLocks[data].lock();
+    }
+
+    static void unlockShare(CURL*, curl_lock_data data, void* userData) {
+        static_cast<StrangerDrumsClient*>(userData)->m_shareLocks[data].unlock();
+    }
+
+    void deliver(const Request& request, const HttpResponse& response) {
+        if (!request.onDone) return;
+
+        auto callback = request.onDone;
+        auto alive = request.alive;
+        if (m_dispatcher) {
+            m_dispatcher([callback, alive, response]() {
+                if (alive->load()) callback(response);
+            });
+        } else if (alive->load()) {
+            callback(response);
+        }
+    }
+
+    APIConfig m_config;
+    StrangerDrumsAPI m_api;
+    Dispatcher m_dispatcher;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;     // new work or shutdown
+    std::condition_variable m_retry;    // cancellation or shutdown, ends backoff waits
+    std::condition_variable m_idle;     // a worker finished a request
+    std::deque<std::shared_ptr<Request>> m_queue;
+    std::vector<std::shared_ptr<Request>> m_active;
+    std::shared_ptr<std::atomic<bool>> m_alive;
+    bool m_stopping = false;
+
+    CURLSH* m_share = nullptr;          // connection cache, DNS and TLS sessions
+    std::mutex m_shareLocks[CURL_LOCK_DATA_LAST];
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
+
+} // namespace StrangerDrums
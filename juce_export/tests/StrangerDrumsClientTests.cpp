@@ -0,0 +1,785 @@
+#include "StrangerDrumsClient.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <future>
+#include <thread>
+
+namespace {
+
+using namespace StrangerDrums;
+using Clock = std::chrono::steady_clock;
+
+int failures = 0;
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+void check(bool ok, const char* expression, const char* file, int line) {
+    if (!ok) {
+        ++failures;
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    }
+}
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+bool waitUntil(const std::function<bool()>& condition, int timeoutMs) {
+    auto start = Clock::now();
+    while (!condition()) {
+        if (msSince(start) > timeoutMs) return false;
+        sleepMs(5);
+    }
+    return true;
+}
+
+// One scripted response of the stand-in server
+struct Reply {
+    Reply(int statusCode, std::string content) : status(statusCode), body(std::move(content)) {}
+
+    int status;
+    std::string body;
+    int delayMs = 0;              // wait after reading the request, before answering
+    int declaredLength = -1;      // Content-Length to claim, -1 for body.size()
+    bool chunked = false;         // Transfer-Encoding: chunked
+    bool omitLastChunk = false;   // chunked body cut off before its terminator
+    int bodyPieces = 1;           // write the body in this many pieces...
+    int pieceDelayMs = 0;         // ...with this long between them
+    std::string extraHeaders;     // "Name: value\r\n" lines
+};
+
+// HTTP/1.1 server on 127.0.0.1 that answers each request with the next
+// scripted Reply (the last one repeats). Connections are kept alive unless the
+// client sends "Connection: close" or the reply is cut off.
+class StandInServer {
+public:
+    explicit StandInServer(std::vector<Reply> scriptedReplies)
+        : replies(std::move(scriptedReplies)) {
+        listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        ::listen(listenFd, 16);
+
+        socklen_t length = sizeof(address);
+        ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+        port = ntohs(address.sin_port);
+
+        acceptThread = std::thread([this] { acceptLoop(); });
+    }
+
+    ~StandInServer() {
+        stopping = true;
+        acceptThread.join();
+        for (auto& handler : handlers) handler.join();
+        ::close(listenFd);
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port); }
+
+    int getRequestCount() const { return requestCount.load(); }
+    int getConnectionCount() const { return connectionCount.load(); }
+    int getMaxConcurrent() const { return maxConcurrent.load(); }
+
+private:
+    std::vector<Reply> replies;
+    int listenFd = -1;
+    int port = 0;
+    std::thread acceptThread;
+    std::vector<std::thread> handlers;
+    std::atomic<bool> stopping { false };
+    std::atomic<int> requestCount { 0 };
+    std::atomic<int> connectionCount { 0 };
+    std::atomic<int> concurrent { 0 };
+    std::atomic<int> maxConcurrent { 0 };
+
+    void acceptLoop() {
+        while (!stopping) {
+            pollfd pfd { listenFd, POLLIN, 0 };
+            if (::poll(&pfd, 1, 50) != 1) continue;
+
+            int fd = ::accept(listenFd, nullptr, nullptr);
+            if (fd < 0) continue;
+
+            int noDelay = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+            ++connectionCount;
+            handlers.emplace_back([this, fd] {
+                serve(fd);
+                ::close(fd);
+            });
+        }
+    }
+
+    void serve(int fd) {
+        std::string buffer;
+        while (!stopping) {
+            std::string request;
+            if (!readRequest(fd, buffer, request)) return;
+
+            Reply reply = replies[static_cast<size_t>(
+                std::min<int>(requestCount++, static_cast<int>(replies.size()) - 1))];
+
+            // Counted until the response is written, so a follow-up request
+            // from the same client can't overlap with it
+            int active = ++concurrent;
+            for (int seen = maxConcurrent.load(); active > seen
+                 && !maxConcurrent.compare_exchange_weak(seen, active); ) {}
+
+            sleepUnlessStopping(reply.delayMs);
+            bool complete = !stopping && writeReply(fd, reply);
+            --concurrent;
+
+            bool cutOff = reply.omitLastChunk
+                || (reply.declaredLength > static_cast<int>(reply.body.size()));
+            auto lower = request;
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+            if (!complete || cutOff || lower.find("connection: close") != std::string::npos) return;
+        }
+    }
+
+    bool writeReply(int fd, const Reply& reply) {
+        std::string head = "HTTP/1.1 " + std::to_string(reply.status) + " Test\r\n"
+            + "Content-Type: application/json\r\n" + reply.extraHeaders;
+        if (reply.chunked) {
+            head += "Transfer-Encoding: chunked\r\n";
+        } else {
+            int declared = reply.declaredLength >= 0 ? reply.declaredLength
+                                                     : static_cast<int>(reply.body.size());
+            head += "Content-Length: " + std::to_string(declared) + "\r\n";
+        }
+        if (!sendAll(fd, head + "\r\n")) return false;
+
+        size_t pieces = static_cast<size_t>(std::max(1, reply.bodyPieces));
+        size_t pieceSize = (reply.body.size() + pieces - 1) / pieces;
+        for (size_t offset = 0; offset < reply.body.size(); offset += pieceSize) {
+            if (offset > 0) sleepUnlessStopping(reply.pieceDelayMs);
+            auto piece = reply.body.substr(offset, pieceSize);
+            if (reply.chunked) {
+                char size[16];
+                std::snprintf(size, sizeof(size), "%zx\r\n", piece.size());
+                piece = size + piece + "\r\n";
+            }
+            if (stopping || !sendAll(fd, piece)) return false;
+        }
+
+        if (reply.chunked && !reply.omitLastChunk) return sendAll(fd, "0\r\n\r\n");
+        return true;
+    }
+
+    static bool sendAll(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            auto n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Reads one request, keeping any bytes of the next one in buffer
+    bool readRequest(int fd, std::string& buffer, std::string& request) {
+        while (!stopping) {
+            auto headerEnd = buffer.find("\r\n\r\n");
+            if (headerEnd != std::string::npos) {
+                auto headers = buffer.substr(0, headerEnd);
+                std::transform(headers.begin(), headers.end(), headers.begin(),
+                    [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+                size_t contentLength = 0;
+                auto lengthAt = headers.find("content-length:");
+                if (lengthAt != std::string::npos) {
+                    contentLength = std::stoul(headers.substr(lengthAt + 15));
+                }
+
+                size_t total = headerEnd + 4 + contentLength;
+                if (buffer.size() >= total) {
+                    request = buffer.substr(0, total);
+                    buffer.erase(0, total);
+                    return true;
+                }
+            }
+
+            pollfd pfd { fd, POLLIN, 0 };
+            int ready = ::poll(&pfd, 1, 50);
+            if (ready < 0) return false;
+            if (ready == 0) continue;
+
+            char chunk[4096];
+            auto n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        return false;
+    }
+
+    void sleepUnlessStopping(int delayMs) {
+        auto start = Clock::now();
+        while (!stopping && msSince(start) < delayMs) sleepMs(5);
+    }
+};
+
+// A port that is bound but not listening: connections to it are refused, and
+// nothing else can take it while this object lives
+class ClosedPort {
+public:
+    ClosedPort() {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+
+        socklen_t length = sizeof(address);
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+        port = ntohs(address.sin_port);
+    }
+
+    ~ClosedPort() { ::close(fd); }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port); }
+
+private:
+    int fd = -1;
+    int port = 0;
+};
+
+APIConfig testConfig(const std::string& baseUrl) {
+    APIConfig config;
+    config.baseUrl = baseUrl;
+    config.timeoutMs = 5000;
+    config.maxRetries = 3;
+    config.retryBaseDelayMs = 10;
+    config.retryMaxDelayMs = 200;
+    return config;
+}
+
+// Posts one request and waits for its completion callback
+HttpResponse postAndWait(StrangerDrumsClient& client, const std::string& url,
+                         int timeoutMs = 10000) {
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    auto future = promise->get_future();
+    client.post(url, "{}", [promise](const HttpResponse& response) {
+        promise->set_value(response);
+    });
+
+    if (future.wait_for(std::chrono::milliseconds(timeoutMs)) != std::future_status::ready) {
+        CHECK(!"request did not complete");
+        return {};
+    }
+    return future.get();
+}
+
+const std::string gridJson =
+    "{\"grid\":[{\"step\":0,\"drum\":\"kick\",\"velocity\":110},"
+    "{\"step\":4,\"drum\":\"snare\",\"velocity\":100}],\"suggestedName\":\"Test Groove\"}";
+
+void testRetryClassification() {
+    CHECK(StrangerDrumsClient::isRetryableStatus(429));
+    CHECK(StrangerDrumsClient::isRetryableStatus(500));
+    CHECK(StrangerDrumsClient::isRetryableStatus(503));
+    CHECK(!StrangerDrumsClient::isRetryableStatus(200));
+    CHECK(!StrangerDrumsClient::isRetryableStatus(400));
+    CHECK(!StrangerDrumsClient::isRetryableStatus(404));
+
+    HttpResponse response;
+    CHECK(StrangerDrumsClient::isRetryable(response));       // never left the client
+
+    response.requestSent = true;
+    CHECK(!StrangerDrumsClient::isRetryable(response));      // lost after sending
+
+    response.statusCode = 503;
+    CHECK(StrangerDrumsClient::isRetryable(response));
+
+    response.statusCode = 200;
+    CHECK(!StrangerDrumsClient::isRetryable(response));      // truncated 2xx
+
+    response.success = true;
+    CHECK(!StrangerDrumsClient::isRetryable(response));
+}
+
+void testBackoffBounds() {
+    APIConfig config;
+    config.retryBaseDelayMs = 100;
+    config.retryMaxDelayMs = 1000;
+    std::mt19937 rng(42);
+
+    for (int attempt = 1; attempt <= 10; ++attempt) {
+        int cap = std::min(1000, 100 << (attempt - 1));
+        int largest = 0;
+
+        for (int i = 0; i < 200; ++i) {
+            int delay = StrangerDrumsClient::backoffDelayMs(config, attempt, rng);
+            CHECK(delay >= 0 && delay <= cap);
+            largest = std::max(largest, delay);
+        }
+
+        // Jitter should still cover most of the range
+        CHECK(largest > cap / 2);
+    }
+}
+
+void testRetryAfter() {
+    APIConfig config;
+    config.retryMaxDelayMs = 8000;
+
+    CHECK(StrangerDrumsClient::retryAfterDelayMs("0", config) == 0);
+    CHECK(StrangerDrumsClient::retryAfterDelayMs("2", config) == 2000);
+    CHECK(StrangerDrumsClient::retryAfterDelayMs(" 3\r\n", config) == 3000);
+    CHECK(StrangerDrumsClient::retryAfterDelayMs("120", config) == 8000);
+    CHECK(StrangerDrumsClient::retryAfterDelayMs("99999999999", config) == 8000);
+    CHECK(StrangerDrumsClient::retryAfterDelayMs("", config) == -1);
+    CHECK(StrangerDrumsClient::retryAfterDelayMs("-5", config) == -1);
+    CHECK(StrangerDrumsClient::retryAfterDelayMs("Wed, 21 Oct 2026 07:28:00 GMT", config) == -1);
+}
+
+void testJsonParser() {
+    detail::JsonValue json;
+    CHECK(detail::JsonParser::parse(
+        " {\"a\": [1, -2.5e1, true, null], \"b\": {\"c\": \"x\\\"\\u00e9\\ud83e\\udd41\"}} ", json));
+    CHECK(json.get("a") != nullptr && json.get("a")->values.size() == 4);
+    CHECK(json.get("a")->values[1].number == -25.0);
+    CHECK(json.get("b")->getString("c") == "x\"\xc3\xa9\xf0\x9f\xa5\x81");
+
+    CHECK(!detail::JsonParser::parse("{\"a\":1} trailing", json));
+    CHECK(!detail::JsonParser::parse("{\"a\":", json));
+    CHECK(!detail::JsonParser::parse("[1,]", json));
+    CHECK(!detail::JsonParser::parse("", json));
+}
+
+void testParseGenerateResponse() {
+    HttpResponse ok;
+    ok.success = true;
+    ok.statusCode = 200;
+    ok.body = gridJson;
+
+    auto parsed = StrangerDrumsClient::parseGenerateResponse(ok);
+    CHECK(parsed.success);
+    CHECK(parsed.grid.size() == 2);
+    CHECK(parsed.grid[0].drum == DrumInstrument::Kick);
+    CHECK(parsed.grid[0].velocity == 110);
+    CHECK(parsed.grid[1].step == 4);
+    CHECK(parsed.grid[1].drum == DrumInstrument::Snare);
+    CHECK(parsed.suggestedName == "Test Groove");
+
+    HttpResponse serverError;
+    serverError.statusCode = 500;
+    serverError.error = "HTTP 500";
+    serverError.body = "{\"message\":\"Failed to generate pattern\"}";
+    parsed = StrangerDrumsClient::parseGenerateResponse(serverError);
+    CHECK(!parsed.success);
+    CHECK(parsed.error == "Failed to generate pattern");
+
+    HttpResponse htmlError = serverError;
+    htmlError.body = "<html>Bad gateway</html>";
+    parsed = StrangerDrumsClient::parseGenerateResponse(htmlError);
+    CHECK(parsed.error == "HTTP 500");
+
+    HttpResponse noGrid = ok;
+    noGrid.body = "{\"suggestedName\":\"x\"}";
+    parsed = StrangerDrumsClient::parseGenerateResponse(noGrid);
+    CHECK(!parsed.success);
+    CHECK(parsed.grid.empty());
+}
+
+void testGeneratePattern() {
+    StandInServer server({ { 200, gridJson } });
+    StrangerDrumsClient client(testConfig(server.url()));
+
+    std::promise<GenerateResponse> promise;
+    auto future = promise.get_future();
+    client.generatePattern(GenerateRequest(), [&promise](const GenerateResponse& response) {
+        promise.set_value(response);
+    });
+
+    CHECK(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    auto result = future.get();
+    CHECK(result.success);
+    CHECK(result.grid.size() == 2);
+    CHECK(result.suggestedName == "Test Groove");
+}
+
+void testRetriesServerErrors() {
+    StandInServer server({ { 503, "{}" }, { 502, "{}" }, { 200, gridJson } });
+    StrangerDrumsClient client(testConfig(server.url()));
+
+    auto response = postAndWait(client, server.url());
+    CHECK(response.success);
+    CHECK(response.statusCode == 200);
+    CHECK(response.attempts == 3);
+    CHECK(response.body == gridJson);
+    CHECK(server.getRequestCount() == 3);
+    CHECK(server.getConnectionCount() == 1);    // retries reuse the connection
+}
+
+void testHonoursRetryAfter() {
+    Reply limited { 429, "{}" };
+    limited.extraHeaders = "Retry-After: 0\r\n";
+    Reply overloaded { 503, "{}" };
+    overloaded.extraHeaders = "retry-after: 1\r\n";
+    StandInServer server({ limited, overloaded, { 200, gridJson } });
+
+    auto config = testConfig(server.url());
+    config.retryMaxDelayMs = 5000;
+    StrangerDrumsClient client(config);
+
+    auto start = Clock::now();
+    auto response = postAndWait(client, server.url());
+    CHECK(response.success);
+    CHECK(response.attempts == 3);
+    CHECK(msSince(start) >= 950);   // waited out the 503's Retry-After
+}
+
+void testRetryAfterIsCapped() {
+    Reply overloaded { 503, "{}" };
+    overloaded.extraHeaders = "Retry-After: 120\r\n";
+    StandInServer server({ overloaded, { 200, "{}" } });
+
+    auto config = testConfig(server.url());
+    config.retryMaxDelayMs = 100;
+    StrangerDrumsClient client(config);
+
+    auto start = Clock::now();
+    auto response = postAndWait(client, server.url());
+    CHECK(response.success);
+    CHECK(response.attempts == 2);
+    CHECK(msSince(start) < 1000);
+}
+
+void testDoesNotRetryClientErrors() {
+    StandInServer server({ { 400, "{\"message\":\"Invalid input\"}" } });
+    StrangerDrumsClient client(testConfig(server.url()));
+
+    auto response = postAndWait(client, server.url());
+    CHECK(!response.success);
+    CHECK(response.statusCode == 400);
+    CHECK(response.attempts == 1);
+    CHECK(server.getRequestCount() == 1);
+    CHECK(response.body == "{\"message\":\"Invalid input\"}");
+}
+
+void testGivesUpAfterMaxRetries() {
+    StandInServer server({ { 500, "{}" } });
+    auto config = testConfig(server.url());
+    config.maxRetries = 2;
+    StrangerDrumsClient client(config);
+
+    auto response = postAndWait(client, server.url());
+    CHECK(!response.success);
+    CHECK(response.statusCode == 500);
+    CHECK(response.attempts == 3);
+    CHECK(server.getRequestCount() == 3);
+}
+
+void testRetriesRefusedConnections() {
+    ClosedPort closed;
+    auto config = testConfig(closed.url());
+    config.maxRetries = 2;
+    StrangerDrumsClient client(config);
+
+    auto response = postAndWait(client, closed.url());
+    CHECK(!response.success);
+    CHECK(response.statusCode == 0);
+    CHECK(!response.requestSent);
+    CHECK(response.attempts == 3);
+    CHECK(response.timing.ttfbMs == 0.0);
+    CHECK(response.timing.bodyMs == 0.0);
+}
+
+void testNoRetryAfterRequestSent() {
+    Reply stalled { 200, gridJson };
+    stalled.delayMs = 3000;
+    StandInServer server({ stalled });
+
+    auto config = testConfig(server.url());
+    config.timeoutMs = 500;
+    StrangerDrumsClient client(config);
+
+    auto start = Clock::now();
+    auto response = postAndWait(client, server.url());
+    CHECK(!response.success);
+    CHECK(response.statusCode == 0);
+    CHECK(response.requestSent);
+    CHECK(response.attempts == 1);
+    CHECK(server.getRequestCount() == 1);
+    CHECK(msSince(start) < 2000);
+}
+
+void testReusesConnections() {
+    StandInServer server({ { 200, "{}" } });
+    StrangerDrumsClient client(testConfig(server.url()));
+
+    auto first = postAndWait(client, server.url());
+    auto second = postAndWait(client, server.url());
+    auto third = postAndWait(client, server.url());
+
+    CHECK(first.success && second.success && third.success);
+    CHECK(server.getRequestCount() == 3);
+    CHECK(server.getConnectionCount() == 1);
+    CHECK(!first.reusedConnection);
+    CHECK(second.reusedConnection);
+    CHECK(third.reusedConnection);
+    CHECK(first.timing.connectMs > 0.0);
+    CHECK(second.timing.connectMs == 0.0);
+}
+
+void testStageTiming() {
+    Reply slow { 200, gridJson };
+    slow.delayMs = 300;
+    slow.bodyPieces = 4;
+    slow.pieceDelayMs = 150;
+    StandInServer server({ slow });
+    StrangerDrumsClient client(testConfig(server.url()));
+
+    auto response = postAndWait(client, server.url());
+    CHECK(response.success);
+    CHECK(response.body == gridJson);
+    CHECK(response.timing.connectMs > 0.0 && response.timing.connectMs < 100.0);
+    CHECK(response.timing.ttfbMs >= 290.0 && response.timing.ttfbMs < 1000.0);
+    CHECK(response.timing.bodyMs >= 440.0 && response.timing.bodyMs < 1500.0);
+    CHECK(response.timing.totalMs >= response.timing.ttfbMs + response.timing.bodyMs);
+}
+
+void testShortResponseIsPrompt() {
+    StandInServer server({ { 200, "{}" } });
+    StrangerDrumsClient client(testConfig(server.url()));
+
+    auto start = Clock::now();
+    auto response = postAndWait(client, server.url());
+    CHECK(response.success);
+    CHECK(msSince(start) < 1000);
+}
+
+void testTruncatedBody() {
+    Reply truncated { 200, "{\"grid\":[{\"step\":0" };
+    truncated.declaredLength = 500;
+    StandInServer server({ truncated, { 200, gridJson } });
+    StrangerDrumsClient client(testConfig(server.url()));
+
+    auto response = postAndWait(client, server.url());
+    CHECK(!response.success);
+    CHECK(response.statusCode == 200);
+    CHECK(response.attempts == 1);
+    CHECK(server.getRequestCount() == 1);
+    CHECK(response.error.find("truncated") != std::string::npos);
+}
+
+void testTruncatedChunkedBody() {
+    Reply truncated { 200, gridJson };
+    truncated.chunked = true;
+    truncated.bodyPieces = 3;
+    truncated.omitLastChunk = true;
+    StandInServer server({ truncated, { 200, gridJson } });
+    StrangerDrumsClient client(testConfig(server.url()));
+
+    auto response = postAndWait(client, server.url());
+    CHECK(!response.success);
+    CHECK(response.statusCode == 200);
+    CHECK(response.attempts == 1);
+    CHECK(server.getRequestCount() == 1);
+
+    Reply complete { 200, gridJson };
+    complete.chunked = true;
+    complete.bodyPieces = 3;
+    StandInServer chunkedServer({ complete });
+    response = postAndWait(client, chunkedServer.url());
+    CHECK(response.success);
+    CHECK(response.body == gridJson);
+}
+
+void testChunksDeliveredOnce() {
+    StandInServer server({ { 503, "{\"message\":\"busy\"}" }, { 200, gridJson } });
+    auto config = testConfig(server.url());
+    config.readChunkSize = 16;
+    StrangerDrumsClient client(config);
+
+    std::mutex lock;
+    std::string streamed;
+    size_t largestChunk = 0;
+    std::promise<HttpResponse> promise;
+    auto future = promise.get_future();
+
+    client.post(server.url(), "{}",
+        [&promise](const HttpResponse& response) { promise.set_value(response); },
+        [&](const char* data, size_t size) {
+            std::lock_guard<std::mutex> guard(lock);
+            largestChunk = std::max(largestChunk, size);
+            streamed.append(data, size);
+        });
+
+    CHECK(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    CHECK(future.get().success);
+
+    std::lock_guard<std::mutex> guard(lock);
+    CHECK(streamed == gridJson);
+    CHECK(largestChunk == 16);
+}
+
+void testLimitsRequestsInFlight() {
+    Reply slow { 200, "{}" };
+    slow.delayMs = 200;
+    StandInServer server({ slow });
+    auto config = testConfig(server.url());
+    config.maxInFlight = 2;
+    StrangerDrumsClient client(config);
+
+    std::atomic<int> completed { 0 };
+    std::atomic<int> succeeded { 0 };
+    for (int i = 0; i < 6; ++i) {
+        client.post(server.url(), "{}", [&](const HttpResponse& response) {
+            if (response.success) ++succeeded;
+            ++completed;
+        });
+    }
+
+    CHECK(waitUntil([&] { return completed == 6; }, 10000));
+    CHECK(succeeded == 6);
+    CHECK(server.getRequestCount() == 6);
+    CHECK(server.getMaxConcurrent() == 2);
+    CHECK(server.getConnectionCount() == 2);    // one kept-alive connection per worker
+    CHECK(waitUntil([&] { return client.getNumPending() == 0; }, 1000));
+}
+
+void testCancelAbortsSlowRequests() {
+    Reply stalled { 200, "{}" };
+    stalled.delayMs = 20000;
+    StandInServer server({ stalled });
+    auto config = testConfig(server.url());
+    config.timeoutMs = 30000;
+    StrangerDrumsClient client(config);
+
+    std::atomic<int> callbacks { 0 };
+    for (int i = 0; i < 6; ++i) {
+        client.post(server.url(), "{}", [&](const HttpResponse&) { ++callbacks; });
+    }
+    CHECK(waitUntil([&] { return server.getRequestCount() == 4; }, 5000));
+
+    auto start = Clock::now();
+    CHECK(client.cancelAll());
+    CHECK(msSince(start) < 500);
+    CHECK(client.getNumPending() == 0);
+
+    sleepMs(100);
+    CHECK(callbacks == 0);
+
+    // The client is still usable afterwards
+    StandInServer fast({ { 200, "{}" } });
+    CHECK(postAndWait(client, fast.url()).success);
+}
+
+void testCancelReportsBusyWorkers() {
+    StandInServer server({ { 200, gridJson } });
+    StrangerDrumsClient client(testConfig(server.url()));
+
+    std::atomic<bool> inChunk { false };
+    std::atomic<bool> done { false };
+    client.post(server.url(), "{}",
+        [&](const HttpResponse&) { done = true; },
+        [&](const char*, size_t) {
+            inChunk = true;
+            sleepMs(StrangerDrumsClient::cancelTimeoutMs + 500);
+        });
+    CHECK(waitUntil([&] { return inChunk.load(); }, 5000));
+
+    CHECK(!client.cancelAll());
+    CHECK(client.getNumPending() == 1);
+
+    CHECK(waitUntil([&] { return client.getNumPending() == 0; }, 5000));
+    CHECK(!done);
+}
+
+void testDispatchedCallbacksDroppedAfterCancel() {
+    StandInServer server({ { 200, "{}" } });
+
+    // Stands in for the message thread's queue
+    std::mutex queueLock;
+    std::vector<std::function<void()>> queue;
+    auto dispatcher = [&](std::function<void()> callback) {
+        std::lock_guard<std::mutex> guard(queueLock);
+        queue.push_back(std::move(callback));
+    };
+    auto queued = [&] {
+        std::lock_guard<std::mutex> guard(queueLock);
+        return queue.size();
+    };
+
+    auto called = std::make_shared<std::atomic<int>>(0);
+    auto client = std::make_unique<StrangerDrumsClient>(testConfig(server.url()), dispatcher);
+
+    client->post(server.url(), "{}", [called](const HttpResponse&) { ++*called; });
+    CHECK(waitUntil([&] { return queued() == 1; }, 5000));
+    client->cancelAll();
+
+    client->post(server.url(), "{}", [called](const HttpResponse&) { ++*called; });
+    CHECK(waitUntil([&] { return queued() == 2; }, 5000));
+    client.reset();
+
+    for (auto& callback : queue) callback();
+    CHECK(*called == 0);
+}
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+const TestCase tests[] = {
+    { "retry classification", testRetryClassification },
+    { "backoff bounds", testBackoffBounds },
+    { "Retry-After parsing", testRetryAfter },
+    { "JSON parser", testJsonParser },
+    { "parseGenerateResponse", testParseGenerateResponse },
+    { "generatePattern", testGeneratePattern },
+    { "retries 5xx", testRetriesServerErrors },
+    { "honours Retry-After on 429 and 503", testHonoursRetryAfter },
+    { "caps Retry-After", testRetryAfterIsCapped },
+    { "does not retry 4xx", testDoesNotRetryClientErrors },
+    { "gives up after maxRetries", testGivesUpAfterMaxRetries },
+    { "retries refused connections", testRetriesRefusedConnections },
+    { "no retry once the request was sent", testNoRetryAfterRequestSent },
+    { "reuses connections", testReusesConnections },
+    { "per-stage timing", testStageTiming },
+    { "short responses are prompt", testShortResponseIsPrompt },
+    { "truncated body", testTruncatedBody },
+    { "truncated chunked body", testTruncatedChunkedBody },
+    { "chunks delivered once", testChunksDeliveredOnce },
+    { "limits requests in flight", testLimitsRequestsInFlight },
+    { "cancelAll aborts slow requests", testCancelAbortsSlowRequests },
+    { "cancelAll reports busy workers", testCancelReportsBusyWorkers },
+    { "dispatched callbacks dropped", testDispatchedCallbacksDroppedAfterCancel },
+};
+
+} // namespace
+
+int main() {
+    int failedTests = 0;
+    for (const auto& test : tests) {
+        int before = failures;
+        auto start = Clock::now();
+        test.run();
+
+        bool passed = failures == before;
+        if (!passed) ++failedTests;
+        std::printf("%s %s (%.0f ms)\n", passed ? "PASS" : "FAIL", test.name, msSince(start));
+    }
+
+    std::printf("%d of %zu tests failed\n", failedTests, sizeof(tests) / sizeof(tests[0]));
+    return failedTests > 0 ? 1 : 0;
+}